@@ -3,6 +3,8 @@
 #include <fmt/core.h>
 #include <argh.h>
 
+#include "utils.h"
+
 namespace uvp
 {
     namespace
@@ -20,6 +22,14 @@ name:           name of the port to update
 -a --auto:      automatically push the ports repo to remote without confirmation 
 -f --fix:       try to fix former failed port update
                 continue amending latest commit instead of starting a new commit
+--plan[=<file>]: only print the changes an update would make, as a unified diff and a JSON summary
+                the summary is written to <file> if specified, otherwise it is printed after the diff,
+                following a line of "=== plan summary ==="
+                nothing is written to the ports repo, committed or built, and the remote repo is not cloned
+                or pulled, so either -l must be specified or the repo must have been cloned by a former update
+                without -l the REF and manifest come from the unpulled clone, which the summary flags as possibly stale
+                the summary lists anything that may make the predicted git-tree differ from what the
+                update commits, e.g. a SHA512 that is pending because the REF changes, or untracked files
 )");
             std::exit(1);
         }
@@ -41,6 +51,14 @@ name:           name of the port to update
 
         config.push = cmd[{ "-a", "--auto" }];
         config.fix = cmd[{ "-f", "--fix" }];
+        // Any form of --plan must stay a dry run, never fall through to a real update
+        config.plan = cmd["--plan"] || cmd.params().contains("plan");
+        if (cmd.params().contains("plan"))
+        {
+            const std::string plan_summary = cmd("--plan").str();
+            if (plan_summary.empty()) error("Missing file name in --plan=<file>");
+            config.plan_summary = absolute(plan_summary);
+        }
 
         return config;
     }
@@ -14,6 +14,8 @@ namespace uvp
         std::optional<fs::path> local_repo;
         bool push = false;
         bool fix = false;
+        bool plan = false;
+        std::optional<fs::path> plan_summary;
 
         static Config from_cmd_args(int argc, const char* const argv[]);
     };
@@ -0,0 +1,125 @@
+#include "diff.h"
+
+#include <algorithm>
+#include <vector>
+#include <fmt/core.h>
+
+namespace uvp
+{
+    namespace
+    {
+        constexpr size_t context_lines = 3;
+
+        struct Edit final
+        {
+            char op; // ' ', '-' or '+'
+            std::string_view line;
+            size_t old_pos; // Number of old lines before this edit
+            size_t new_pos; // Number of new lines before this edit
+        };
+
+        // Split text into lines, each line keeps its trailing newline if there is one
+        std::vector<std::string_view> split_lines(std::string_view text)
+        {
+            std::vector<std::string_view> lines;
+            while (!text.empty())
+            {
+                const size_t newline = text.find('\n');
+                const size_t length = newline == std::string_view::npos ? text.size() : newline + 1;
+                lines.push_back(text.substr(0, length));
+                text.remove_prefix(length);
+            }
+            return lines;
+        }
+
+        std::vector<Edit> diff_lines(const std::vector<std::string_view>& old_lines,
+            const std::vector<std::string_view>& new_lines)
+        {
+            // Edits on registry files are local, so strip the common prefix and suffix
+            // to keep the quadratic LCS table small
+            size_t prefix = 0;
+            while (prefix < old_lines.size() && prefix < new_lines.size() &&
+                old_lines[prefix] == new_lines[prefix])
+                prefix++;
+            size_t suffix = 0;
+            while (suffix < old_lines.size() - prefix && suffix < new_lines.size() - prefix &&
+                old_lines[old_lines.size() - 1 - suffix] == new_lines[new_lines.size() - 1 - suffix])
+                suffix++;
+
+            const size_t n = old_lines.size() - prefix - suffix;
+            const size_t m = new_lines.size() - prefix - suffix;
+            std::vector<size_t> lcs((n + 1) * (m + 1));
+            const auto at = [&](const size_t i, const size_t j) -> size_t& { return lcs[i * (m + 1) + j]; };
+            for (size_t i = n; i-- > 0;)
+                for (size_t j = m; j-- > 0;)
+                    at(i, j) = old_lines[prefix + i] == new_lines[prefix + j] ?
+                                   at(i + 1, j + 1) + 1 :
+                                   std::max(at(i + 1, j), at(i, j + 1));
+
+            std::vector<Edit> edits;
+            size_t i = 0, j = 0;
+            const auto push = [&](const char op)
+            {
+                const std::string_view line = op == '+' ? new_lines[j] : old_lines[i];
+                edits.push_back({ op, line, i, j });
+                if (op != '+') i++;
+                if (op != '-') j++;
+            };
+            while (i < prefix) push(' ');
+            while (i < prefix + n || j < prefix + m)
+            {
+                const size_t mi = i - prefix, mj = j - prefix;
+                if (mi < n && mj < m && old_lines[i] == new_lines[j]) push(' ');
+                else if (mi < n && (mj == m || at(mi + 1, mj) >= at(mi, mj + 1))) push('-');
+                else push('+');
+            }
+            while (i < old_lines.size()) push(' ');
+            return edits;
+        }
+
+        void append_line(std::string& result, const char op, const std::string_view line)
+        {
+            result += op;
+            result += line;
+            if (!line.ends_with('\n')) result += "\n\\ No newline at end of file\n";
+        }
+    }
+
+    std::string unified_diff(const std::string_view old_text, const std::string_view new_text,
+        const std::string_view old_label, const std::string_view new_label)
+    {
+        const auto edits = diff_lines(split_lines(old_text), split_lines(new_text));
+        const auto is_change = [&](const size_t index) { return edits[index].op != ' '; };
+
+        std::string result;
+        size_t index = 0;
+        while (true)
+        {
+            while (index < edits.size() && !is_change(index)) index++;
+            if (index == edits.size()) break;
+
+            // Changes closer than twice the context length are merged into one hunk
+            const size_t begin = index >= context_lines ? index - context_lines : 0;
+            size_t last_change = index;
+            for (size_t i = index + 1; i < edits.size() && i <= last_change + 2 * context_lines; i++)
+                if (is_change(i)) last_change = i;
+            const size_t end = std::min(edits.size(), last_change + context_lines + 1);
+
+            const auto count_lines = [&](const char excluded_op)
+            {
+                return static_cast<size_t>(std::count_if(edits.begin() + begin, edits.begin() + end,
+                    [excluded_op](const Edit& edit) { return edit.op != excluded_op; }));
+            };
+            const size_t old_count = count_lines('+');
+            const size_t new_count = count_lines('-');
+            const size_t old_start = edits[begin].old_pos + (old_count == 0 ? 0 : 1);
+            const size_t new_start = edits[begin].new_pos + (new_count == 0 ? 0 : 1);
+
+            if (result.empty()) result = fmt::format("--- {}\n+++ {}\n", old_label, new_label);
+            result += fmt::format("@@ -{},{} +{},{} @@\n", old_start, old_count, new_start, new_count);
+            for (size_t i = begin; i < end; i++) append_line(result, edits[i].op, edits[i].line);
+            index = end;
+        }
+        return result;
+    }
+}
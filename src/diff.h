@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+
+namespace uvp
+{
+    // Make a unified diff with 3 lines of context between two texts, returns an empty string if they're equal
+    std::string unified_diff(std::string_view old_text, std::string_view new_text,
+        std::string_view old_label, std::string_view new_label);
+}
@@ -0,0 +1,443 @@
+#include "git.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <vector>
+
+#include "utils.h"
+
+namespace uvp
+{
+    namespace
+    {
+        using ObjectId = std::array<unsigned char, 20>;
+
+        class Sha1 final
+        {
+        private:
+            std::array<std::uint32_t, 5> state_{ 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+            std::array<unsigned char, 64> block_{};
+            size_t block_size_ = 0;
+            std::uint64_t length_ = 0;
+
+            void process_block()
+            {
+                std::array<std::uint32_t, 80> w{};
+                for (size_t i = 0; i < 16; i++)
+                    w[i] = std::uint32_t(block_[i * 4]) << 24 | std::uint32_t(block_[i * 4 + 1]) << 16 |
+                        std::uint32_t(block_[i * 4 + 2]) << 8 | std::uint32_t(block_[i * 4 + 3]);
+                for (size_t i = 16; i < 80; i++)
+                    w[i] = std::rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+                auto [a, b, c, d, e] = state_;
+                for (size_t i = 0; i < 80; i++)
+                {
+                    std::uint32_t f, k;
+                    if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+                    else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+                    else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+                    else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+                    const std::uint32_t temp = std::rotl(a, 5) + f + e + k + w[i];
+                    e = d;
+                    d = c;
+                    c = std::rotl(b, 30);
+                    b = a;
+                    a = temp;
+                }
+                state_[0] += a;
+                state_[1] += b;
+                state_[2] += c;
+                state_[3] += d;
+                state_[4] += e;
+            }
+
+            void push_byte(const unsigned char byte)
+            {
+                block_[block_size_++] = byte;
+                if (block_size_ == block_.size())
+                {
+                    process_block();
+                    block_size_ = 0;
+                }
+            }
+
+        public:
+            void update(const std::string_view data)
+            {
+                for (const char ch : data) push_byte(static_cast<unsigned char>(ch));
+                length_ += data.size();
+            }
+
+            ObjectId finish()
+            {
+                const std::uint64_t bit_length = length_ * 8;
+                push_byte(0x80);
+                while (block_size_ != 56) push_byte(0);
+                for (int i = 7; i >= 0; i--) push_byte(static_cast<unsigned char>(bit_length >> (i * 8)));
+                ObjectId result{};
+                for (size_t i = 0; i < 20; i++)
+                    result[i] = static_cast<unsigned char>(state_[i / 4] >> (24 - i % 4 * 8));
+                return result;
+            }
+        };
+
+        ObjectId hash_object(const std::string_view type, const std::string_view content)
+        {
+            Sha1 sha1;
+            sha1.update(fmt::format("{} {}", type, content.size()));
+            sha1.update({ "", 1 }); // Null terminator of the header
+            sha1.update(content);
+            return sha1.finish();
+        }
+
+        std::string to_hex(const ObjectId& id)
+        {
+            std::string result;
+            for (const unsigned char byte : id) result += fmt::format("{:02x}", byte);
+            return result;
+        }
+
+        std::string trim(std::string str)
+        {
+            while (!str.empty() && std::isspace(static_cast<unsigned char>(str.back()))) str.pop_back();
+            return str;
+        }
+
+        // Returns the per-worktree git dir and the common git dir (where refs are stored) of a repo
+        std::pair<fs::path, fs::path> find_git_dirs(const fs::path& repo_path)
+        {
+            fs::path git_dir = repo_path / ".git";
+            if (is_regular_file(git_dir)) // Worktrees and submodules use a file with "gitdir: <path>"
+            {
+                constexpr std::string_view prefix = "gitdir: ";
+                const std::string content = trim(read_all_text(git_dir));
+                if (!content.starts_with(prefix)) error("Invalid .git file in {}", repo_path.string());
+                git_dir = repo_path / content.substr(prefix.size());
+            }
+            if (!is_directory(git_dir)) error("{} is not a git repo", repo_path.string());
+            fs::path common_dir = git_dir;
+            if (const fs::path common_file = git_dir / "commondir"; exists(common_file))
+                common_dir = git_dir / trim(read_all_text(common_file));
+            return { git_dir, common_dir };
+        }
+
+        std::optional<std::string> read_ref(const fs::path& git_dir, const fs::path& common_dir, const std::string& ref)
+        {
+            for (const fs::path& dir : { git_dir, common_dir })
+                if (const fs::path path = dir / ref; is_regular_file(path))
+                    return trim(read_all_text(path));
+            if (const fs::path packed = common_dir / "packed-refs"; exists(packed))
+            {
+                std::istringstream stream(read_all_text(packed));
+                std::string line;
+                while (std::getline(stream, line))
+                {
+                    if (line.empty() || line[0] == '#' || line[0] == '^') continue;
+                    if (const size_t space = line.find(' ');
+                        space != std::string::npos && trim(line.substr(space + 1)) == ref)
+                        return line.substr(0, space);
+                }
+            }
+            return std::nullopt;
+        }
+
+        std::uint32_t read_u32(const std::string_view data, const size_t offset)
+        {
+            std::uint32_t result = 0;
+            for (size_t i = 0; i < 4; i++) result = result << 8 | static_cast<unsigned char>(data[offset + i]);
+            return result;
+        }
+
+        struct IndexEntry final
+        {
+            std::uint32_t mode = 0;
+            ObjectId id{};
+        };
+
+        // Read the stage 0 entries of the git index, keyed by their paths relative to the repo
+        std::map<std::string, IndexEntry> read_index(const fs::path& git_dir)
+        {
+            std::map<std::string, IndexEntry> entries;
+            const fs::path path = git_dir / "index";
+            if (!exists(path)) return entries;
+            const std::string data = read_all_bytes(path);
+            const auto check_size = [&](const size_t size)
+            {
+                if (size > data.size()) error("Corrupted git index {}", path.string());
+            };
+
+            check_size(12);
+            if (data.compare(0, 4, "DIRC") != 0) error("Corrupted git index {}", path.string());
+            const std::uint32_t version = read_u32(data, 4);
+            if (version < 2 || version > 4) error("Unsupported git index version {}", version);
+            const std::uint32_t count = read_u32(data, 8);
+
+            size_t offset = 12;
+            std::string entry_path;
+            for (std::uint32_t i = 0; i < count; i++)
+            {
+                // 40 bytes of stat data, 20 bytes of object id and 2 bytes of flags
+                const size_t begin = offset;
+                check_size(offset + 62);
+                IndexEntry entry;
+                entry.mode = read_u32(data, offset + 24);
+                std::copy_n(data.begin() + static_cast<std::ptrdiff_t>(offset + 40), entry.id.size(), entry.id.begin());
+                const auto flags = static_cast<std::uint16_t>(read_u32(data, offset + 58));
+                offset += 62;
+                if (version >= 3 && (flags & 0x4000)) offset += 2; // Extended flags
+
+                if (version == 4) // Paths are prefix compressed against the previous entry
+                {
+                    check_size(offset + 1);
+                    auto byte = static_cast<unsigned char>(data[offset++]);
+                    size_t strip = byte & 0x7f;
+                    while (byte & 0x80)
+                    {
+                        check_size(offset + 1);
+                        byte = static_cast<unsigned char>(data[offset++]);
+                        strip = (strip + 1) << 7 | (byte & 0x7f);
+                    }
+                    if (strip > entry_path.size()) error("Corrupted git index {}", path.string());
+                    entry_path.resize(entry_path.size() - strip);
+                }
+                else
+                    entry_path.clear();
+
+                const size_t path_end = data.find('\0', offset);
+                if (path_end == std::string::npos) error("Corrupted git index {}", path.string());
+                entry_path.append(data, offset, path_end - offset);
+                offset = path_end + 1;
+                if (version != 4) offset = begin + ((offset - begin + 7) & ~size_t(7)); // NUL padding
+
+                if ((flags >> 12 & 3) == 0) entries[entry_path] = entry;
+            }
+            return entries;
+        }
+
+        std::optional<std::string> get_env(const char* name)
+        {
+#ifdef _MSC_VER
+#pragma warning(suppress: 4996)
+#endif
+            const char* value = std::getenv(name);
+            if (value == nullptr || *value == '\0') return std::nullopt;
+            return value;
+        }
+
+        std::string to_lower(std::string str)
+        {
+            for (char& ch : str) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+            return str;
+        }
+
+        // The subset of the git config that changes what git add stores
+        struct CoreConfig final
+        {
+            std::optional<std::string> autocrlf;
+            std::optional<std::string> file_mode;
+        };
+
+        // Read the [core] section of a git config file, include directives are not followed
+        void read_core_config(const fs::path& path, CoreConfig& config)
+        {
+            if (!is_regular_file(path)) return;
+            std::istringstream stream(read_all_text(path));
+            std::string line;
+            bool in_core = false;
+            while (std::getline(stream, line))
+            {
+                line = trim(std::move(line));
+                line.erase(0, line.find_first_not_of(" \t"));
+                if (line.empty() || line[0] == '#' || line[0] == ';') continue;
+                if (line[0] == '[')
+                {
+                    in_core = to_lower(line.substr(1, line.find_first_of(" \t\"]") - 1)) == "core";
+                    continue;
+                }
+                if (!in_core) continue;
+                const size_t equal = line.find('=');
+                const std::string key = to_lower(trim(line.substr(0, equal)));
+                // A key without a value means true
+                std::string value = equal == std::string::npos ? "true" : line.substr(equal + 1);
+                value = to_lower(trim(value.substr(0, value.find_first_of("#;"))));
+                value.erase(0, value.find_first_not_of(" \t\""));
+                if (!value.empty() && value.back() == '"') value.pop_back();
+                if (key == "autocrlf") config.autocrlf = value;
+                else if (key == "filemode") config.file_mode = value;
+            }
+        }
+
+        bool is_true(const std::string_view value)
+        {
+            return value == "true" || value == "yes" || value == "on" || value == "1";
+        }
+
+        // Read the system, global and repo config files, later ones take precedence
+        CoreConfig read_core_config(const fs::path& common_dir)
+        {
+            CoreConfig config;
+#ifndef _WIN32 // The system config of Git for Windows lives in its installation directory
+            read_core_config("/etc/gitconfig", config);
+#endif
+            auto home = get_env("HOME");
+            if (!home) home = get_env("USERPROFILE");
+            if (const auto xdg = get_env("XDG_CONFIG_HOME"))
+                read_core_config(fs::path(*xdg) / "git/config", config);
+            else if (home)
+                read_core_config(fs::path(*home) / ".config/git/config", config);
+            if (home) read_core_config(fs::path(*home) / ".gitconfig", config);
+            read_core_config(common_dir / "config", config);
+            return config;
+        }
+
+        // With core.autocrlf set to true or input, git add stores CRLF as LF in files that aren't binary
+        std::string to_stored_content(std::string content, const bool convert_crlf)
+        {
+            if (!convert_crlf || content.find('\0') != std::string::npos) return content;
+            std::string result;
+            result.reserve(content.size());
+            for (size_t i = 0; i < content.size(); i++)
+                if (content[i] != '\r' || i + 1 == content.size() || content[i + 1] != '\n')
+                    result += content[i];
+            return result;
+        }
+
+        struct TreeContext final
+        {
+            std::map<std::string, IndexEntry> index;
+            bool convert_crlf = false;
+            bool file_mode = true;
+            std::vector<std::string> caveats;
+        };
+
+        std::optional<ObjectId> hash_tree_impl(TreeContext& context, const fs::path& dir, const std::string& prefix,
+            const std::map<std::string, std::string_view>& overrides)
+        {
+            struct Entry
+            {
+                std::string name;
+                std::string mode;
+                ObjectId id;
+            };
+            std::vector<Entry> entries;
+
+            const auto file_mode = [&](const IndexEntry* tracked, const bool executable) -> std::string
+            {
+                if (!context.file_mode) return tracked ? fmt::format("{:o}", tracked->mode) : "100644";
+                return executable ? "100755" : "100644";
+            };
+            const auto add_file = [&](std::string name, const std::string& content,
+                const bool symlink, const bool executable)
+            {
+                const auto iter = context.index.find(prefix + name);
+                const IndexEntry* tracked = iter == context.index.end() ? nullptr : &iter->second;
+                ObjectId id = hash_object("blob", symlink ? content : to_stored_content(content, context.convert_crlf));
+                // Git doesn't convert line endings of a file if the blob in the index has CRLF already
+                if (tracked && tracked->id != id && hash_object("blob", content) == tracked->id) id = tracked->id;
+                entries.push_back({ std::move(name), symlink ? "120000" : file_mode(tracked, executable), id });
+            };
+
+            for (const auto& file : fs::directory_iterator(dir))
+            {
+                std::string name = file.path().filename().string();
+                if (name == ".git") continue;
+                if (name == ".gitattributes")
+                    context.caveats.push_back(fmt::format("{}{} is not applied", prefix, name));
+                const auto status = file.symlink_status();
+                if (is_directory(status))
+                {
+                    // Git doesn't track empty directories
+                    if (const auto id = hash_tree_impl(context, file.path(), prefix + name + '/', {}))
+                        entries.push_back({ std::move(name), "40000", *id });
+                    continue;
+                }
+
+                const bool executable = (status.permissions() & fs::perms::owner_exec) != fs::perms::none;
+                if (const auto iter = overrides.find(name); iter != overrides.end())
+                    add_file(std::move(name), std::string(iter->second), false, executable);
+                else if (!context.index.contains(prefix + name))
+                    context.caveats.push_back(fmt::format(
+                        "untracked file {}{} is left out, git add -A includes it unless it's ignored", prefix, name));
+                else if (is_symlink(status))
+                    add_file(std::move(name), read_symlink(file.path()).generic_string(), true, false);
+                else
+                    add_file(std::move(name), read_all_bytes(file.path()), false, executable);
+            }
+            for (const auto& [name, content] : overrides)
+                if (std::ranges::find(entries, name, &Entry::name) == entries.end())
+                    add_file(name, std::string(content), false, false);
+
+            if (entries.empty()) return std::nullopt;
+
+            // Git sorts tree entries as if the names of subtrees end with a slash
+            const auto sort_key = [](const Entry& entry) { return entry.mode == "40000" ? entry.name + '/' : entry.name; };
+            std::ranges::sort(entries, {}, sort_key);
+            std::string content;
+            for (const auto& [name, mode, id] : entries)
+            {
+                content += fmt::format("{} {}", mode, name);
+                content += '\0';
+                content.append(reinterpret_cast<const char*>(id.data()), id.size());
+            }
+            return hash_object("tree", content);
+        }
+    }
+
+    std::string read_head_commit(const fs::path& repo_path)
+    {
+        const auto [git_dir, common_dir] = find_git_dirs(repo_path);
+        std::string head = trim(read_all_text(git_dir / "HEAD"));
+        // Follow symbolic refs, the depth limit is the same as git's
+        for (int depth = 0; depth < 5; depth++)
+        {
+            constexpr std::string_view prefix = "ref: ";
+            if (!head.starts_with(prefix)) return head;
+            const std::string ref = head.substr(prefix.size());
+            if (auto value = read_ref(git_dir, common_dir, ref)) head = std::move(*value);
+            else error("Cannot resolve git ref {} in {}", ref, repo_path.string());
+        }
+        error("Too deeply nested symbolic refs in {}", repo_path.string());
+    }
+
+    TreePrediction predict_tree(const fs::path& repo_path, const fs::path& dir,
+        const std::map<std::string, std::string_view>& overrides)
+    {
+        const auto [git_dir, common_dir] = find_git_dirs(repo_path);
+        TreeContext context;
+        context.index = read_index(git_dir);
+
+        const CoreConfig config = read_core_config(common_dir);
+        context.convert_crlf = config.autocrlf && (*config.autocrlf == "input" || is_true(*config.autocrlf));
+#ifdef _WIN32
+        // Git for Windows runs with core.fileMode=false, and the executable bit from the
+        // filesystem is meaningless there, so the modes always come from the index
+        context.file_mode = false;
+        if (!config.autocrlf)
+            context.caveats.push_back("core.autocrlf is not set in the global or repo config, "
+                "assuming false, but the system config of Git for Windows may set it");
+#else
+        context.file_mode = !config.file_mode || is_true(*config.file_mode);
+#endif
+
+        // Attributes may change line endings or add filters, which are not applied
+        for (fs::path path = dir; ; path = path.parent_path())
+        {
+            if (exists(repo_path / path / ".gitattributes") && path != dir)
+                context.caveats.push_back(fmt::format("{} is not applied",
+                    (path / ".gitattributes").generic_string()));
+            if (path.empty()) break;
+        }
+        if (exists(common_dir / "info/attributes"))
+            context.caveats.push_back("info/attributes is not applied");
+
+        std::string prefix = dir.generic_string();
+        if (!prefix.empty() && !prefix.ends_with('/')) prefix += '/';
+        const auto id = hash_tree_impl(context, repo_path / dir, prefix, overrides);
+        return { to_hex(id.value_or(hash_object("tree", {}))), std::move(context.caveats) };
+    }
+}
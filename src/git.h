@@ -0,0 +1,26 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+namespace uvp
+{
+    namespace fs = std::filesystem;
+
+    // Resolve HEAD of a git repo to a commit id by reading the refs directly, without spawning git
+    std::string read_head_commit(const fs::path& repo_path);
+
+    struct TreePrediction final
+    {
+        std::string id;
+        std::vector<std::string> caveats; // Reasons why git may store a different tree
+    };
+
+    // Predict the tree object id that git add -A would store for a directory of a repo, dir is relative to
+    // the repo. Files named in overrides (directly under dir) take the given content as the exact bytes that
+    // will be on disk, and are added if missing. Only tracked and overridden files are hashed.
+    TreePrediction predict_tree(const fs::path& repo_path, const fs::path& dir,
+        const std::map<std::string, std::string_view>& overrides = {});
+}
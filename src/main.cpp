@@ -1,8 +1,15 @@
+#include "planner.h"
 #include "updater.h"
 #include "utils.h"
 
 int main(const int argc, const char* const argv[]) // NOLINT
 {
-    try { uvp::Updater(uvp::Config::from_cmd_args(argc, argv)).run(); }
+    try
+    {
+        if (auto config = uvp::Config::from_cmd_args(argc, argv); config.plan)
+            uvp::Planner(std::move(config)).run();
+        else
+            uvp::Updater(std::move(config)).run();
+    }
     catch (const std::exception& e) { uvp::error("Exception: {}", e.what()); }
 }
@@ -10,7 +10,7 @@ namespace uvp
     namespace nl = nlohmann;
 
     Manifest::Manifest(fs::path path):
-        path_(std::move(path))
+        path_(std::move(path)), content_(read_all_text(path_))
     {
         constexpr std::array<std::string_view, 4> arr
         {
@@ -20,7 +20,7 @@ namespace uvp
             "version-string"
         };
 
-        const auto j = nl::json::parse(read_all_text(path_));
+        const auto j = nl::json::parse(content_);
         for (const auto& [k, v] : j.items())
         {
             if (std::ranges::find(arr, k) != arr.end())
@@ -32,4 +32,12 @@ namespace uvp
                 port_version_ = v.get<int>();
         }
     }
+
+    fs::path find_manifest(const fs::path& repo_path)
+    {
+        for (const char* name : { "vcpkg-interface.json", "vcpkg.json" })
+            if (const fs::path path = repo_path / name; exists(path))
+                return canonical(path);
+        return {};
+    }
 }
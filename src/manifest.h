@@ -10,6 +10,7 @@ namespace uvp
     {
     private:
         fs::path path_;
+        std::string content_;
         std::string version_type_;
         std::string version_;
         int port_version_ = 0;
@@ -17,9 +18,14 @@ namespace uvp
     public:
         Manifest() = default;
         explicit Manifest(fs::path path);
+        const fs::path& path() const { return path_; }
+        std::string_view content() const { return content_; }
         std::string_view version_type() const { return version_type_; }
         std::string_view version() const { return version_; }
         int port_version() const { return port_version_; }
         void copy_to(const fs::path& path) const { copy(path_, path, fs::copy_options::update_existing); }
     };
+
+    // Find the manifest file in a library repo, returns an empty path if there's none
+    fs::path find_manifest(const fs::path& repo_path);
 }
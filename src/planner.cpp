@@ -0,0 +1,164 @@
+#include "planner.h"
+#include "diff.h"
+#include "registry.h"
+
+namespace uvp
+{
+    namespace
+    {
+        std::string as_written_in_text_mode(const std::string_view text)
+        {
+#ifdef _WIN32
+            std::string result;
+            for (const char ch : text)
+            {
+                if (ch == '\n') result += '\r';
+                result += ch;
+            }
+            return result;
+#else
+            return std::string(text);
+#endif
+        }
+    }
+
+    void Planner::get_portfile()
+    {
+        portfile_ = Portfile(config_.ports_path / "ports" / config_.name / "portfile.cmake");
+        summary_["port"] = config_.name;
+        summary_["repo"] = portfile_.repo();
+    }
+
+    void Planner::find_new_ref()
+    {
+        if (config_.local_repo)
+        {
+            new_ref_ = read_head_commit(*config_.local_repo);
+            summary_["ref-source"] = "local";
+            return;
+        }
+
+        // Cloning or pulling would be a side effect, so only use what's already on disk
+        const fs::path repo_dir = config_.ports_path / "temp" / fs::path(portfile_.repo()).stem();
+        if (!is_directory(repo_dir))
+            error("Remote repo {} is not cloned yet, specify a local repo with -l", portfile_.repo());
+        config_.local_repo = canonical(repo_dir);
+        new_ref_ = read_head_commit(*config_.local_repo);
+        summary_["ref-source"] = "clone";
+        caveats_.push_back(fmt::format("the clone of {} is not pulled, REF and manifest come from its HEAD, "
+            "which may be behind the remote, pull it or specify a local repo with -l", portfile_.repo()));
+    }
+
+    void Planner::get_manifest()
+    {
+        const fs::path path = find_manifest(*config_.local_repo);
+        if (path.empty()) error("Cannot find manifest file (vcpkg.json)");
+        manifest_ = Manifest(path);
+        summary_["version"] = nl::json{
+            { manifest_.version_type(), manifest_.version() },
+            { "port-version", manifest_.port_version() }
+        };
+    }
+
+    void Planner::plan_port_files()
+    {
+        const fs::path port_path = fs::path("ports") / config_.name;
+        const fs::path port_dir = config_.ports_path / port_path;
+
+        const std::string old_portfile(portfile_.content());
+        const std::string old_ref(portfile_.ref());
+        portfile_.set_ref(new_ref_);
+        summary_["ref"] = nl::json{ { "from", old_ref }, { "to", new_ref_ } };
+        add_change(port_path / "portfile.cmake", old_portfile, std::string(portfile_.content()));
+
+        // Same semantics as copying with fs::copy_options::update_existing
+        const fs::path manifest_path = port_dir / "vcpkg.json";
+        const bool copy_manifest = !exists(manifest_path) ||
+                                   last_write_time(manifest_.path()) > last_write_time(manifest_path);
+        std::string old_manifest = exists(manifest_path) ? read_all_text(manifest_path) : std::string();
+        std::string new_manifest = copy_manifest ? std::string(manifest_.content()) : old_manifest;
+
+        // The tree is hashed from the bytes that would be on disk: the portfile is saved in text mode,
+        // and the manifest is copied verbatim
+        const std::string portfile_bytes = as_written_in_text_mode(portfile_.content());
+        const std::string manifest_bytes = copy_manifest ? read_all_bytes(manifest_.path()) : std::string();
+        std::map<std::string, std::string_view> overrides{ { "portfile.cmake", portfile_bytes } };
+        if (copy_manifest) overrides.emplace("vcpkg.json", manifest_bytes);
+        tree_ = predict_tree(config_.ports_path, port_path, overrides);
+
+        // A new REF means a new tarball, whose hash is only known after vcpkg downloads it,
+        // the update then fixes the SHA512 and the git-tree changes with it
+        const bool sha512_pending = old_ref != new_ref_;
+        summary_["sha512"] = nl::json{ { "current", portfile_.sha512() }, { "pending", sha512_pending } };
+        if (sha512_pending)
+            tree_.caveats.push_back("SHA512 of the new REF is unknown, "
+                "the git-tree will change once vcpkg reports the actual hash");
+        add_change(port_path / "vcpkg.json", std::move(old_manifest), std::move(new_manifest));
+    }
+
+    void Planner::plan_baseline()
+    {
+        const fs::path path = "versions/baseline.json";
+        std::string old_text = read_all_text(config_.ports_path / path);
+        auto json = nl::json::parse(old_text);
+        const auto& defaults = json["default"];
+        summary_["baseline"]["from"] = defaults.contains(config_.name) ? defaults[config_.name] : nl::json();
+        update_baseline(json, config_.name, manifest_);
+        summary_["baseline"]["to"] = json["default"][config_.name];
+        add_change(path, std::move(old_text), json.dump(4));
+    }
+
+    void Planner::plan_version_file()
+    {
+        const fs::path path = version_file_path({}, config_.name);
+        if (!exists(config_.ports_path / path)) error("Cannot find version file {}", path.generic_string());
+        std::string old_text = read_all_text(config_.ports_path / path);
+        auto json = nl::json::parse(old_text);
+        const bool fixed = update_version_entry(json, manifest_, tree_.id);
+        // The tree is computed from the same sources as the rest of the plan, so plan caveats apply to it too
+        summary_["version-file"] = nl::json{
+            { "path", path.generic_string() },
+            { "action", fixed ? "update" : "insert" },
+            { "git-tree", tree_.id },
+            { "git-tree-reliable", tree_.caveats.empty() && caveats_.empty() },
+            { "git-tree-caveats", tree_.caveats }
+        };
+        add_change(path, std::move(old_text), json.dump(4));
+    }
+
+    void Planner::add_change(fs::path path, std::string before, std::string after)
+    {
+        if (before == after) return;
+        summary_["changed-files"].push_back(path.generic_string());
+        changes_.push_back({ std::move(path), std::move(before), std::move(after) });
+    }
+
+    void Planner::print_plan()
+    {
+        summary_["reliable"] = caveats_.empty();
+        summary_["caveats"] = caveats_;
+        for (const auto& caveat : caveats_)
+            fmt::print(stderr, "Warning: the plan may be outdated, {}\n", caveat);
+        for (const auto& caveat : tree_.caveats)
+            fmt::print(stderr, "Warning: the predicted git-tree may be wrong, {}\n", caveat);
+        for (const auto& [path, before, after] : changes_)
+            fmt::print("{}", unified_diff(before, after,
+                "a/" + path.generic_string(), "b/" + path.generic_string()));
+        if (config_.plan_summary)
+            write_all_text(*config_.plan_summary, summary_.dump(4));
+        else
+            fmt::print("=== plan summary ===\n{}\n", summary_.dump(4));
+    }
+
+    void Planner::run()
+    {
+        summary_["changed-files"] = nl::json::array();
+        get_portfile();
+        find_new_ref();
+        get_manifest();
+        plan_port_files();
+        plan_baseline();
+        plan_version_file();
+        print_plan();
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "config.h"
+#include "git.h"
+#include "manifest.h"
+#include "portfile.h"
+
+namespace uvp
+{
+    namespace nl = nlohmann;
+
+    // Computes the changes an update would make to the ports repo without writing anything
+    class Planner final
+    {
+    private:
+        struct FileChange final
+        {
+            fs::path path; // Relative to the ports path
+            std::string before;
+            std::string after;
+        };
+
+        Config config_;
+        Portfile portfile_;
+        Manifest manifest_;
+        std::string new_ref_;
+        std::vector<FileChange> changes_;
+        TreePrediction tree_;
+        std::vector<std::string> caveats_; // Reasons why the whole plan may differ from the update
+        nl::json summary_;
+
+        void get_portfile();
+        void find_new_ref();
+        void get_manifest();
+        void plan_port_files();
+        void plan_baseline();
+        void plan_version_file();
+        void add_change(fs::path path, std::string before, std::string after);
+        void print_plan();
+
+    public:
+        explicit Planner(Config config): config_(std::move(config)) {}
+        void run();
+    };
+}
@@ -23,6 +23,7 @@ namespace uvp
         std::string_view repo() const { return repo_; }
         std::string_view ref() const { return { ref_.data(), ref_.size() }; }
         std::string_view sha512() const { return { sha512_.data(), sha512_.size() }; }
+        std::string_view content() const { return content_; }
         void set_ref(const std::string_view str) { overwrite_span(ref_, str); }
         void set_sha512(const std::string_view str) { overwrite_span(sha512_, str); }
         void save() const { write_all_text(path_, content_); }
@@ -0,0 +1,46 @@
+#include "registry.h"
+
+#include <nlohmann/json.hpp>
+
+namespace uvp
+{
+    fs::path version_file_path(const fs::path& ports_path, const std::string& name)
+    {
+        const char initial[]{ name[0], '-', '\0' };
+        return ports_path / "versions" / initial / (name + ".json");
+    }
+
+    void update_baseline(nl::json& baseline, const std::string& name, const Manifest& manifest)
+    {
+        baseline["default"][name] = nl::json{
+            { "baseline", manifest.version() },
+            { "port-version", manifest.port_version() }
+        };
+    }
+
+    bool update_version_entry(nl::json& version_file, const Manifest& manifest, const std::string_view git_tree)
+    {
+        auto& versions = version_file["versions"];
+        if (const bool fix_front_version = [&]
+        {
+            if (versions.empty()) return false;
+            const auto& front = versions.front();
+            if (const auto iter = front.find(manifest.version_type());
+                iter == front.end() || iter.value().get_ref<const std::string&>() != manifest.version())
+                return false;
+            const auto iter = front.find("port-version");
+            if (iter == front.end()) return manifest.port_version() == 0;
+            return iter.value().get<int>() == manifest.port_version();
+        }(); fix_front_version)
+        {
+            versions.front()["git-tree"] = git_tree;
+            return true;
+        }
+        versions.insert(versions.begin(), nl::json{
+            { manifest.version_type(), manifest.version() },
+            { "port-version", manifest.port_version() },
+            { "git-tree", git_tree }
+        });
+        return false;
+    }
+}
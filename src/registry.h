@@ -0,0 +1,20 @@
+#pragma once
+
+#include <nlohmann/json_fwd.hpp>
+
+#include "manifest.h"
+
+namespace uvp
+{
+    namespace nl = nlohmann;
+
+    // Path of the version file of a port, i.e. versions/<initial>-/<name>.json
+    fs::path version_file_path(const fs::path& ports_path, const std::string& name);
+
+    // Set the baseline entry of a port in the parsed baseline.json
+    void update_baseline(nl::json& baseline, const std::string& name, const Manifest& manifest);
+
+    // Add or fix the front entry of the parsed version file of a port,
+    // returns true if the front entry already had the manifest version and was fixed in place
+    bool update_version_entry(nl::json& version_file, const Manifest& manifest, std::string_view git_tree);
+}
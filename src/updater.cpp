@@ -1,5 +1,6 @@
 #include "updater.h"
 #include "command.h"
+#include "registry.h"
 
 #include <nlohmann/json.hpp>
 
@@ -50,20 +51,10 @@ namespace uvp
     void Updater::get_manifest()
     {
         info("Finding manifest file (vcpkg.json)...");
-        if (const fs::path inter = *config_.local_repo / "vcpkg-interface.json";
-            exists(inter))
-        {
-            manifest_ = Manifest(canonical(inter));
-            fmt::print("Found vcpkg-interface.json, using this file\n");
-        }
-        else if (const fs::path normal = *config_.local_repo / "vcpkg.json";
-            exists(normal))
-        {
-            manifest_ = Manifest(canonical(normal));
-            fmt::print("Found vcpkg.json, using this file\n");
-        }
-        else
-            error("Cannot find manifest file (vcpkg.json)");
+        const fs::path path = find_manifest(*config_.local_repo);
+        if (path.empty()) error("Cannot find manifest file (vcpkg.json)");
+        manifest_ = Manifest(path);
+        fmt::print("Found {}, using this file\n", path.filename().string());
         fmt::print("{}: {}, port-version: {}\n",
             manifest_.version_type(), manifest_.version(), manifest_.port_version());
     }
@@ -98,10 +89,7 @@ namespace uvp
             info("Updating baseline...");
             const auto path = config_.ports_path / "versions/baseline.json";
             auto json = nl::json::parse(read_all_text(path));
-            json["default"][config_.name] = nl::json{
-                { "baseline", manifest_.version() },
-                { "port-version", manifest_.port_version() }
-            };
+            update_baseline(json, config_.name, manifest_);
             write_all_text(path, json.dump(4));
         }
         {
@@ -123,28 +111,9 @@ namespace uvp
         {
             info("Updating version file...");
             const auto obj = run_command(fmt::format("git rev-parse HEAD:ports/{}", config_.name)).output[0];
-            const char initial[]{ config_.name[0], '-', '\0' };
-            version_file_ = canonical(config_.ports_path / "versions" / initial / (config_.name + ".json"));
+            version_file_ = canonical(version_file_path(config_.ports_path, config_.name));
             auto json = nl::json::parse(read_all_text(version_file_));
-            auto& versions = json["versions"];
-            if (const bool fix_front_version = [&]
-            {
-                if (versions.empty()) return false;
-                const auto& front = versions.front();
-                if (const auto iter = front.find(manifest_.version_type());
-                    iter == front.end() || iter.value().get_ref<const std::string&>() != manifest_.version())
-                    return false;
-                const auto iter = front.find("port-version");
-                if (iter == front.end()) return manifest_.port_version() == 0;
-                return iter.value().get<int>() == manifest_.port_version();
-            }(); fix_front_version)
-                versions.front()["git-tree"] = obj;
-            else
-                versions.insert(versions.begin(), nl::json{
-                    { manifest_.version_type(), manifest_.version() },
-                    { "port-version", manifest_.port_version() },
-                    { "git-tree", obj }
-                });
+            update_version_entry(json, manifest_, obj);
             write_all_text(version_file_, json.dump(4));
             run_command("git add -A");
             run_command("git commit --amend --no-edit");
@@ -22,6 +22,14 @@ namespace uvp
         return result;
     }
 
+    std::string read_all_bytes(const fs::path& path)
+    {
+        std::ifstream fs(path, std::ios::binary);
+        std::string result((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+        if (fs.bad() || !fs.is_open()) error("Failed to read file: {}", path.string());
+        return result;
+    }
+
     void write_all_text(const fs::path& path, const std::string_view str)
     {
         std::ofstream fs(path);
@@ -25,5 +25,6 @@ namespace uvp
 
     void overwrite_span(std::span<char> span, std::string_view str);
     std::string read_all_text(const fs::path& path);
+    std::string read_all_bytes(const fs::path& path); // Without newline conversion
     void write_all_text(const fs::path& path, std::string_view str);
 }